@@ -0,0 +1,103 @@
+#include "batch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <numbers>
+#include <thread>
+
+int run_batch(const BatchOptions& options) {
+    std::vector<Vec3> views = options.rotations;
+    int steps = views.empty() && options.turntable_steps == 0 ? 8 : options.turntable_steps;
+    for (int i = 0; i < steps; ++i) {
+        views.push_back(Vec3(0.0, (2.0 * std::numbers::pi * i) / steps, 0.0));
+    }
+
+    // more workers than jobs would idle, and far more than cores only adds renderers to keep in memory
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int thread_count = options.threads != 0 ? std::min(options.threads, cores * MAX_THREADS_PER_CORE) : cores;
+    std::atomic<int> failures = 0;
+
+    auto run_workers = [thread_count](size_t job_count, auto&& work) {
+        std::vector<std::jthread> workers;
+        for (size_t i = 0; i < std::min<size_t>(thread_count, job_count); ++i) {
+            workers.emplace_back(work);
+        }
+    };
+
+    // load every asset once, several files at a time
+    size_t mesh_count = options.mesh_paths.size();
+    std::vector<Mesh> meshes(options.compact_storage ? 0 : mesh_count);
+    std::vector<CompactMesh> compact_meshes(options.compact_storage ? mesh_count : 0);
+    std::vector<uint8_t> loaded(mesh_count, 0);
+    std::atomic<size_t> next_mesh = 0;
+    run_workers(mesh_count, [&]() {
+        for (size_t i = next_mesh++; i < mesh_count; i = next_mesh++) {
+            try {
+                if (options.compact_storage) {
+                    compact_meshes[i] = compact_mesh(get_mesh_from_obj_file(options.mesh_paths[i]));
+                } else {
+                    meshes[i] = get_mesh_from_obj_file(options.mesh_paths[i]);
+                }
+                loaded[i] = 1;
+            } catch (const std::string& e) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", e.c_str());
+            } catch (const std::exception& e) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "failed to parse %s: %s", options.mesh_paths[i].c_str(), e.what());
+            }
+        }
+    });
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.output_dir, ec);
+    if (ec) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Create output directory %s: %s", options.output_dir.c_str(), ec.message().c_str());
+        return static_cast<int>(mesh_count * views.size());
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    size_t job_count = mesh_count * views.size();
+    std::atomic<size_t> next_job = 0;
+    std::atomic<int> written = 0;
+
+    thread_count = static_cast<unsigned int>(std::min<size_t>(thread_count, job_count));
+    run_workers(job_count, [&]() {
+        Renderer rs;
+        rs.initialize_headless(options.scale);
+        rs.set_msaa(options.msaa_samples);
+
+        for (size_t job = next_job++; job < job_count; job = next_job++) {
+            size_t mesh_i = job / views.size();
+            size_t view_i = job % views.size();
+            if (!loaded[mesh_i]) {
+                ++failures;
+                continue;
+            }
+
+            rs.camera.rotation = views[view_i];
+            if (options.compact_storage) {
+                rs.transform_mesh(compact_meshes[mesh_i]);
+            } else {
+                rs.transform_mesh(meshes[mesh_i]);
+            }
+            rs.sort_triangles();
+            rs.rasterize();
+
+            // the mesh index keeps same-named assets from different folders apart, so every
+            // job owns its path and no two workers can write, or overwrite, the same file
+            std::string stem = std::filesystem::path(options.mesh_paths[mesh_i]).stem().string();
+            std::filesystem::path out = std::filesystem::path(options.output_dir) / std::format("{}_{}_{:03}.bmp", stem, mesh_i, view_i);
+            if (rs.save_image(out.string())) {
+                ++written;
+            } else {
+                ++failures;
+            }
+            rs.clear_buffer();
+        }
+    });
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    SDL_Log("Rendered %d images with %u threads in %.3f s (%.2f images/sec)", written.load(), thread_count, seconds, written / seconds);
+    return failures;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "renderer.hpp"
+
+#include <string>
+#include <vector>
+
+// upper bound for --threads, relative to the hardware threads
+constexpr unsigned int MAX_THREADS_PER_CORE = 4;
+
+struct BatchOptions {
+    public:
+        std::vector<std::string> mesh_paths;
+        std::vector<Vec3> rotations;
+        int turntable_steps = 0;
+        std::string output_dir = ".";
+        float scale = 0.5f;
+        int msaa_samples = MSAA_OFF;
+        // 0 picks one worker per hardware thread
+        unsigned int threads = 0;
+        bool compact_storage = false;
+};
+
+// Renders every mesh from every view off-screen and writes one bmp per (mesh, view).
+// Meshes are loaded once and shared read-only; each worker owns its own Renderer.
+// Returns the number of images that failed to load or save.
+int run_batch(const BatchOptions& options);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "compact_mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+constexpr double QUANTIZE_MAX = std::numeric_limits<uint16_t>::max();
+constexpr double SNORM_MAX = std::numeric_limits<int16_t>::max();
+
+CompactMesh compact_mesh(const Mesh& mesh) {
+    CompactMesh compact;
+    compact.rot = mesh.rot;
+
+    std::vector<Vec3> face_normals;
+    face_normals.reserve(mesh.faces.size());
+    for (const std::array<int, 3>& face : mesh.faces) {
+        const Vec3& a = mesh.vertices[face[0] - 1];
+        const Vec3& b = mesh.vertices[face[1] - 1];
+        const Vec3& c = mesh.vertices[face[2] - 1];
+        face_normals.push_back(cross(b - a, c - a));
+    }
+
+    compact.positions.reserve(mesh.vertices.size());
+    compact.normals.reserve(mesh.faces.size());
+
+    // chunk c of the vertices and chunk c of the faces share a cluster; smaller boxes quantize
+    // finer, and faces of nearby vertices keep their offsets in 16 bits
+    auto chunk = [](auto span, size_t c) {
+        size_t first = std::min(span.size(), c * COMPACT_CLUSTER_SIZE);
+        return span.subspan(first, std::min(COMPACT_CLUSTER_SIZE, span.size() - first));
+    };
+    size_t cluster_count = (std::max(mesh.vertices.size(), mesh.faces.size()) + COMPACT_CLUSTER_SIZE - 1) / COMPACT_CLUSTER_SIZE;
+    for (size_t c = 0; c < cluster_count; ++c) {
+        compact.add_cluster(chunk(std::span<const Vec3>(mesh.vertices), c),
+                            chunk(std::span<const std::array<int, 3>>(mesh.faces), c),
+                            chunk(std::span<const Vec3>(face_normals), c));
+    }
+
+    return compact;
+}
+
+void CompactMesh::add_cluster(std::span<const Vec3> vertices, std::span<const std::array<int, 3>> faces, std::span<const Vec3> face_normals) {
+    CompactCluster cluster;
+
+    Vec3 lo(0, 0, 0), hi(0, 0, 0);
+    if (!vertices.empty()) {
+        lo = hi = vertices[0];
+    }
+    for (const Vec3& v : vertices) {
+        lo = Vec3(std::min(lo.x, v.x), std::min(lo.y, v.y), std::min(lo.z, v.z));
+        hi = Vec3(std::max(hi.x, v.x), std::max(hi.y, v.y), std::max(hi.z, v.z));
+    }
+    cluster.bounds_min = lo;
+    cluster.bounds_step = (hi - lo) * (1 / QUANTIZE_MAX);
+
+    auto quantize = [](double value, double min, double step) -> uint16_t {
+        if (step == 0) return 0;
+        return static_cast<uint16_t>(std::clamp(std::round((value - min) / step), 0.0, QUANTIZE_MAX));
+    };
+    cluster.first_vertex = static_cast<uint32_t>(positions.size());
+    cluster.vertex_count = static_cast<uint32_t>(vertices.size());
+    for (const Vec3& v : vertices) {
+        positions.push_back({
+            quantize(v.x, cluster.bounds_min.x, cluster.bounds_step.x),
+            quantize(v.y, cluster.bounds_min.y, cluster.bounds_step.y),
+            quantize(v.z, cluster.bounds_min.z, cluster.bounds_step.z)
+        });
+    }
+
+    int index_min = faces.empty() ? 1 : faces[0][0];
+    int index_max = index_min;
+    for (const std::array<int, 3>& face : faces) {
+        for (int i : face) {
+            index_min = std::min(index_min, i);
+            index_max = std::max(index_max, i);
+        }
+    }
+    cluster.index_base = static_cast<uint32_t>(index_min - 1);
+    cluster.wide_indices = index_max - index_min > std::numeric_limits<uint16_t>::max();
+
+    cluster.first_face = static_cast<uint32_t>(normals.size());
+    cluster.face_count = static_cast<uint32_t>(faces.size());
+    cluster.first_index = static_cast<uint32_t>(cluster.wide_indices ? indices32.size() : indices16.size());
+    for (const std::array<int, 3>& face : faces) {
+        for (int i : face) {
+            uint32_t offset = static_cast<uint32_t>(i - 1) - cluster.index_base;
+            if (cluster.wide_indices) {
+                indices32.push_back(offset);
+            } else {
+                indices16.push_back(static_cast<uint16_t>(offset));
+            }
+        }
+    }
+    for (const Vec3& normal : face_normals) {
+        normals.push_back(encode_octahedral(normal));
+    }
+
+    clusters.push_back(cluster);
+}
+
+void CompactMesh::append(const CompactMesh& batch) {
+    for (CompactCluster cluster : batch.clusters) {
+        cluster.first_vertex += static_cast<uint32_t>(positions.size());
+        cluster.first_face += static_cast<uint32_t>(normals.size());
+        cluster.first_index += static_cast<uint32_t>(cluster.wide_indices ? indices32.size() : indices16.size());
+        clusters.push_back(cluster);
+    }
+    positions.insert(positions.end(), batch.positions.begin(), batch.positions.end());
+    indices16.insert(indices16.end(), batch.indices16.begin(), batch.indices16.end());
+    indices32.insert(indices32.end(), batch.indices32.begin(), batch.indices32.end());
+    normals.insert(normals.end(), batch.normals.begin(), batch.normals.end());
+}
+
+Vec3 CompactMesh::dequantize(size_t vertex) const noexcept {
+    // the last cluster starting at or before the vertex is the one holding it
+    auto it = std::upper_bound(clusters.begin(), clusters.end(), vertex, [](size_t v, const CompactCluster& cluster) {
+        return v < cluster.first_vertex;
+    });
+    const CompactCluster& cluster = *(it - 1);
+    const std::array<uint16_t, 3>& q = positions[vertex];
+    return {
+        cluster.bounds_min.x + (q[0] * cluster.bounds_step.x),
+        cluster.bounds_min.y + (q[1] * cluster.bounds_step.y),
+        cluster.bounds_min.z + (q[2] * cluster.bounds_step.z)
+    };
+}
+
+std::array<int16_t, 2> encode_octahedral(const Vec3& n) noexcept {
+    double l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (l1 == 0) return { 0, 0 };
+
+    // project onto the octahedron, then fold the lower half over the diagonals
+    double x = n.x / l1;
+    double y = n.y / l1;
+    if (n.z < 0) {
+        double fx = (1 - std::abs(y)) * (x >= 0 ? 1 : -1);
+        double fy = (1 - std::abs(x)) * (y >= 0 ? 1 : -1);
+        x = fx;
+        y = fy;
+    }
+
+    return {
+        static_cast<int16_t>(std::round(std::clamp(x, -1.0, 1.0) * SNORM_MAX)),
+        static_cast<int16_t>(std::round(std::clamp(y, -1.0, 1.0) * SNORM_MAX))
+    };
+}
+
+Vec3 decode_octahedral(const std::array<int16_t, 2>& e) noexcept {
+    double x = e[0] / SNORM_MAX;
+    double y = e[1] / SNORM_MAX;
+    double z = 1 - std::abs(x) - std::abs(y);
+    if (z < 0) {
+        double fx = (1 - std::abs(y)) * (x >= 0 ? 1 : -1);
+        double fy = (1 - std::abs(x)) * (y >= 0 ? 1 : -1);
+        x = fx;
+        y = fy;
+    }
+
+    return normalized(Vec3(x, y, z));
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef COMPACT_MESH_H
+#define COMPACT_MESH_H
+
+#include "mesh.hpp"
+#include "vec.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// vertices, and separately faces, per cluster when compacting a whole Mesh
+constexpr size_t COMPACT_CLUSTER_SIZE = 1 << 14;
+
+// A run of vertices and a run of faces inside a CompactMesh. The vertices are quantized within
+// the cluster's own bounding box, and the faces index vertices as index_base plus a 16-bit
+// offset whenever their range allows.
+struct CompactCluster {
+    public:
+        Vec3 bounds_min;
+        Vec3 bounds_step;
+        uint32_t first_vertex = 0;
+        uint32_t vertex_count = 0;
+        uint32_t first_face = 0;
+        uint32_t face_count = 0;
+        // into indices32 when wide_indices is set, indices16 otherwise
+        uint32_t first_index = 0;
+        uint32_t index_base = 0;
+        bool wide_indices = false;
+};
+
+// Quantized copy of a Mesh, split into clusters: positions are 16-bit fractions of their
+// cluster's bounding box, indices are 16-bit offsets whenever a cluster's faces allow it, and
+// each face keeps an octahedral encoded normal.
+struct CompactMesh {
+    public:
+        std::vector<CompactCluster> clusters;
+        std::vector<std::array<uint16_t, 3>> positions;
+        std::vector<uint16_t> indices16;
+        std::vector<uint32_t> indices32;
+        std::vector<std::array<int16_t, 2>> normals;
+        Vec3 rot;
+
+        inline size_t face_count() const noexcept { return normals.size(); }
+        // vertex of corner i of the cluster's faces, 0-based over the whole mesh
+        inline uint32_t index(const CompactCluster& cluster, size_t i) const noexcept {
+            return cluster.index_base + (cluster.wide_indices ? indices32[cluster.first_index + i] : indices16[cluster.first_index + i]);
+        }
+
+        // appends a cluster, for callers that stream the mesh in; faces are 1-based like
+        // Mesh::faces and may reference vertices of any cluster, face_normals has one per face
+        void add_cluster(std::span<const Vec3> vertices, std::span<const std::array<int, 3>> faces, std::span<const Vec3> face_normals);
+        // appends the clusters of a batch built on its own, rebasing their ranges
+        void append(const CompactMesh& batch);
+        // vertex is 0-based over the whole mesh
+        Vec3 dequantize(size_t vertex) const noexcept;
+};
+
+CompactMesh compact_mesh(const Mesh& mesh);
+
+std::array<int16_t, 2> encode_octahedral(const Vec3& n) noexcept;
+Vec3 decode_octahedral(const std::array<int16_t, 2>& e) noexcept;
+
+#endif
\ No newline at end of file
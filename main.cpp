@@ -1,10 +1,23 @@
+#include "batch.hpp"
 #include "renderer.hpp"
 
 void on_exit();
+bool parse_options(int argc, const char* argv[], RendererOptions& options);
+bool parse_batch_options(int argc, const char* argv[], BatchOptions& options);
 
 int main(int argc, const char* argv[]) {
-    if (argc < 3) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "usage: ./renderer_3d <window_name> <path_to_obj_file>");
+    if (argc >= 2 && std::string(argv[1]) == "--batch") {
+        BatchOptions batch_options;
+        if (!parse_batch_options(argc, argv, batch_options)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "usage: ./renderer_3d --batch <output_dir> [--steps <n>] [--rotation <x,y,z>]... [--scale <0-1>] [--msaa <0|4|8>] [--threads <n>] [--compact] <path_to_obj_file>...");
+            return 1;
+        }
+        return run_batch(batch_options) == 0 ? 0 : 1;
+    }
+
+    RendererOptions options;
+    if (argc < 3 || !parse_options(argc, argv, options)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "usage: ./renderer_3d <window_name> <path_to_obj_file> [--fps <n>] [--dynamic-res] [--min-scale <0-1>] [--max-scale <0-1>] [--compact] [--sync-load]");
         return 1;
     }
     int success = atexit(on_exit);
@@ -17,7 +30,7 @@ int main(int argc, const char* argv[]) {
     std::string window_name { argv[1] };
     std::string mesh_path { argv[2] };
     try {
-        rs.initialize(window_name, mesh_path);
+        rs.initialize(window_name, mesh_path, options);
     } catch (...) {
         return 1;
     }
@@ -39,6 +52,81 @@ int main(int argc, const char* argv[]) {
     }
 }
 
+bool parse_options(int argc, const char* argv[], RendererOptions& options) {
+    try {
+        for (int i = 3; i < argc; ++i) {
+            std::string arg { argv[i] };
+            if (arg == "--dynamic-res") {
+                options.dynamic_resolution = true;
+            } else if (arg == "--compact") {
+                options.compact_storage = true;
+            } else if (arg == "--sync-load") {
+                options.async_load = false;
+            } else if (i + 1 >= argc) {
+                return false;
+            } else if (arg == "--fps") {
+                options.target_fps = std::stof(argv[++i]);
+            } else if (arg == "--min-scale") {
+                options.min_scale = std::stof(argv[++i]);
+            } else if (arg == "--max-scale") {
+                options.max_scale = std::stof(argv[++i]);
+            } else {
+                return false;
+            }
+        }
+    } catch (...) {
+        return false;
+    }
+
+    // the texture is window sized, so the internal framebuffer can only shrink
+    return options.target_fps > 0.0f
+        && options.min_scale > 0.0f
+        && options.min_scale <= options.max_scale
+        && options.max_scale <= 1.0f;
+}
+
+bool parse_batch_options(int argc, const char* argv[], BatchOptions& options) {
+    if (argc < 4) return false;
+    options.output_dir = argv[2];
+
+    try {
+        for (int i = 3; i < argc; ++i) {
+            std::string arg { argv[i] };
+            if (!arg.starts_with("--")) {
+                options.mesh_paths.push_back(arg);
+            } else if (arg == "--compact") {
+                options.compact_storage = true;
+            } else if (i + 1 >= argc) {
+                return false;
+            } else if (arg == "--steps") {
+                options.turntable_steps = std::stoi(argv[++i]);
+            } else if (arg == "--rotation") {
+                auto angles = split(argv[++i], ",");
+                if (angles.size() != 3) return false;
+                options.rotations.push_back(Vec3(std::stod(angles[0]), std::stod(angles[1]), std::stod(angles[2])));
+            } else if (arg == "--scale") {
+                options.scale = std::stof(argv[++i]);
+            } else if (arg == "--msaa") {
+                options.msaa_samples = std::stoi(argv[++i]);
+            } else if (arg == "--threads") {
+                // stoul would wrap a negative count around to a huge one
+                int threads = std::stoi(argv[++i]);
+                if (threads < 1) return false;
+                options.threads = threads;
+            } else {
+                return false;
+            }
+        }
+    } catch (...) {
+        return false;
+    }
+
+    return !options.mesh_paths.empty()
+        && options.turntable_steps >= 0
+        && options.scale > 0.0f
+        && (options.msaa_samples == MSAA_OFF || options.msaa_samples == MSAA_4X || options.msaa_samples == MSAA_8X);
+}
+
 void on_exit() {
     SDL_Quit();
     SDL_Log("Successfully exited.");
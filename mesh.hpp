@@ -20,5 +20,6 @@ struct Mesh {
 };
 
 Mesh get_mesh_from_obj_file(std::string file_path);
+void parse_obj_line(const std::string& line, Mesh& mesh);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "mesh_loader.hpp"
+
+MeshLoader::~MeshLoader() {
+    cancelled = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+    while (head != nullptr) {
+        Node* next = head->next.load();
+        delete head;
+        head = next;
+    }
+}
+
+void MeshLoader::start(std::string file_path, bool compact) {
+    std::ifstream ifile = std::ifstream(file_path);
+    if (!ifile.is_open()) {
+        throw std::format("failed to open filepath: {}", file_path.data());
+    }
+
+    head = tail = new Node;
+    worker = std::thread(compact ? &MeshLoader::load_compact : &MeshLoader::load, this, std::move(ifile));
+}
+
+bool MeshLoader::poll(Mesh& mesh) {
+    return drain([&mesh](Node& node) {
+        // vertices first, a batch's faces may reference vertices from the same batch
+        Mesh& batch = node.batch;
+        mesh.vertices.insert(mesh.vertices.end(), batch.vertices.begin(), batch.vertices.end());
+        mesh.faces.insert(mesh.faces.end(), batch.faces.begin(), batch.faces.end());
+        mesh.textures.insert(mesh.textures.end(), batch.textures.begin(), batch.textures.end());
+        mesh.normals.insert(mesh.normals.end(), batch.normals.begin(), batch.normals.end());
+        batch = {};
+    });
+}
+
+bool MeshLoader::poll(CompactMesh& mesh) {
+    return drain([&mesh](Node& node) {
+        mesh.append(node.compact_batch);
+        node.compact_batch = {};
+    });
+}
+
+bool MeshLoader::done() const noexcept {
+    return head != nullptr
+        && finished.load(std::memory_order_acquire)
+        && head->next.load(std::memory_order_acquire) == nullptr;
+}
+
+void MeshLoader::load(std::ifstream ifile) {
+    Mesh batch;
+    std::string line;
+
+    try {
+        while (!cancelled.load(std::memory_order_relaxed) && std::getline(ifile, line)) {
+            parse_obj_line(line, batch);
+            if (batch.vertices.size() + batch.faces.size() >= MESH_BATCH_ELEMENTS) {
+                publish(batch);
+            }
+        }
+    } catch (const std::exception& e) {
+        error = std::format("failed to parse line '{}': {}", line, e.what());
+    }
+
+    publish(batch);
+    finished.store(true, std::memory_order_release);
+}
+
+void MeshLoader::load_compact(std::ifstream ifile) {
+    // every batch is quantized within its own bounds once it fills up, so it leaves after one
+    // batch worth of lines and only the batch being parsed is ever held at full precision
+    Mesh batch;
+    CompactMesh resident;
+    std::string line;
+
+    try {
+        while (!cancelled.load(std::memory_order_relaxed) && std::getline(ifile, line)) {
+            parse_obj_line(line, batch);
+            if (batch.vertices.size() + batch.faces.size() >= MESH_BATCH_ELEMENTS) {
+                publish_compact(batch, resident);
+            }
+        }
+    } catch (const std::exception& e) {
+        error = std::format("failed to parse line '{}': {}", line, e.what());
+    }
+
+    publish_compact(batch, resident);
+    finished.store(true, std::memory_order_release);
+}
+
+void MeshLoader::publish(Mesh& batch) {
+    if (batch.vertices.empty() && batch.faces.empty()) return;
+
+    Node* node = new Node;
+    node->batch = std::move(batch);
+    batch = {};
+    tail->next.store(node, std::memory_order_release);
+    tail = node;
+}
+
+void MeshLoader::publish_compact(Mesh& batch, CompactMesh& resident) {
+    if (batch.vertices.empty() && batch.faces.empty()) return;
+
+    // face normals come from the quantized positions, the ones that get rendered; resident is
+    // this thread's copy of every quantized position so far, a face may reach back to any batch
+    if (!batch.vertices.empty()) {
+        resident.add_cluster(batch.vertices, {}, {});
+    }
+    face_normals.clear();
+    for (const std::array<int, 3>& face : batch.faces) {
+        Vec3 a = resident.dequantize(face[0] - 1);
+        Vec3 b = resident.dequantize(face[1] - 1);
+        Vec3 c = resident.dequantize(face[2] - 1);
+        face_normals.push_back(cross(b - a, c - a));
+    }
+
+    Node* node = new Node;
+    node->compact_batch.add_cluster(batch.vertices, batch.faces, face_normals);
+    batch.vertices.clear();
+    batch.faces.clear();
+    batch.textures.clear();
+    batch.normals.clear();
+    tail->next.store(node, std::memory_order_release);
+    tail = node;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef MESH_LOADER_H
+#define MESH_LOADER_H
+
+#include "compact_mesh.hpp"
+#include "mesh.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+
+// vertices plus faces parsed before a batch is handed to the render thread
+constexpr size_t MESH_BATCH_ELEMENTS = 1 << 14;
+
+// Parses an obj file on a background thread. Finished batches are handed to the render thread
+// through a lock-free single producer, single consumer linked queue. In compact mode every batch
+// is quantized into its own cluster on the loader thread, so the full precision mesh is never
+// resident and the file is still read only once.
+class MeshLoader {
+    public:
+        // set by the loader thread when parsing stops early, read it once done() is true
+        std::string error;
+
+        MeshLoader() = default;
+        ~MeshLoader();
+
+        MeshLoader(const MeshLoader&) = delete;
+        MeshLoader& operator=(const MeshLoader&) = delete;
+
+        // opens the file on the calling thread, so a bad path still throws at startup
+        void start(std::string file_path, bool compact = false);
+        // appends every batch that has arrived so far, returns whether anything was appended;
+        // use the overload matching the mode passed to start
+        bool poll(Mesh& mesh);
+        bool poll(CompactMesh& mesh);
+        bool done() const noexcept;
+
+    private:
+        struct Node {
+            Mesh batch;
+            CompactMesh compact_batch;
+            std::atomic<Node*> next = nullptr;
+        };
+
+        // head is a consumed stub owned by the render thread, tail belongs to the loader thread
+        Node* head = nullptr;
+        Node* tail = nullptr;
+        std::atomic<bool> finished = false;
+        std::atomic<bool> cancelled = false;
+        std::thread worker;
+        // reused across compact batches by the loader thread
+        std::vector<Vec3> face_normals;
+
+        void load(std::ifstream ifile);
+        void load_compact(std::ifstream ifile);
+        void publish(Mesh& batch);
+        void publish_compact(Mesh& batch, CompactMesh& resident);
+
+        template <typename F>
+        bool drain(F&& consume) {
+            if (head == nullptr) return false;
+
+            bool appended = false;
+            Node* next;
+            while ((next = head->next.load(std::memory_order_acquire)) != nullptr) {
+                consume(*next);
+                delete head;
+                head = next;
+                appended = true;
+            }
+            return appended;
+        }
+};
+
+#endif
\ No newline at end of file
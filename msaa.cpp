@@ -0,0 +1,201 @@
+#include "msaa.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// sample positions inside the unit pixel, rotated grid for 4x and the standard 8x pattern
+const std::array<Vec2, 4> SAMPLES_4X = {{
+    { 0.375, 0.125 }, { 0.875, 0.375 }, { 0.125, 0.625 }, { 0.625, 0.875 }
+}};
+const std::array<Vec2, 8> SAMPLES_8X = {{
+    { 0.5625, 0.3125 }, { 0.4375, 0.6875 }, { 0.8125, 0.5625 }, { 0.3125, 0.1875 },
+    { 0.1875, 0.8125 }, { 0.0625, 0.4375 }, { 0.6875, 0.9375 }, { 0.9375, 0.0625 }
+}};
+
+void SampleBuffer::resize(int width, int height, int sample_count) {
+    w = width;
+    h = height;
+    samples = sample_count;
+    colors = nullptr;
+    slots.assign(w*h, -1);
+    pool.clear();
+    touched.clear();
+}
+
+void SampleBuffer::begin(std::vector<uint32_t>& frame) noexcept {
+    // no copy, pixels without a slot are drawn straight into the frame
+    colors = frame.data();
+}
+
+void SampleBuffer::resolve() noexcept {
+    for (int32_t i : touched) {
+        // collapsed pixels, or ones listed twice, already hold their color
+        if (slots[i] < 0) continue;
+
+        const uint32_t* s = &pool[slots[i] * samples];
+        uint32_t r = 0, g = 0, b = 0, a = 0;
+        for (int k = 0; k < samples; ++k) {
+            r += (s[k] >> 24) & 0xff;
+            g += (s[k] >> 16) & 0xff;
+            b += (s[k] >> 8) & 0xff;
+            a += s[k] & 0xff;
+        }
+        colors[i] = ((r / samples) << 24) | ((g / samples) << 16) | ((b / samples) << 8) | (a / samples);
+        slots[i] = -1;
+    }
+
+    // both keep their capacity, so edge pixels only allocate on the first few frames
+    touched.clear();
+    pool.clear();
+}
+
+void SampleBuffer::write(int x, int y, uint32_t mask, uint32_t color) noexcept {
+    if (x < 0 || x >= w || y < 0 || y >= h || mask == 0) return;
+    int i = (w * y) + x;
+
+    if (mask == full_mask()) {
+        colors[i] = color;
+        slots[i] = -1;
+        return;
+    }
+
+    int32_t slot = slots[i];
+    if (slot < 0) {
+        if (colors[i] == color) return;
+        // a collapsed pixel abandons its slot, the pool is reset on the next resolve anyway
+        slot = static_cast<int32_t>(pool.size()) / samples;
+        pool.insert(pool.end(), samples, colors[i]);
+        slots[i] = slot;
+        touched.push_back(i);
+    }
+
+    uint32_t* s = &pool[slot * samples];
+    for (int k = 0; k < samples; ++k) {
+        if (mask & (1u << k)) { s[k] = color; }
+    }
+}
+
+void SampleBuffer::fill_triangle(const std::array<Vec2, 3>& points, uint32_t color) noexcept {
+    fill_convex(points, color);
+}
+
+void SampleBuffer::fill_line(Vec2 a, Vec2 b, uint32_t color) noexcept {
+    if (a == b) return;
+
+    // one pixel wide quad through the pixel centers the dda line would hit
+    a += 0.5;
+    b += 0.5;
+    Vec2 n = perpendicular(normalized(b - a)) * 0.5;
+    fill_convex(std::array<Vec2, 4> { a + n, b + n, b - n, a - n }, color);
+}
+
+template <size_t N>
+void SampleBuffer::fill_convex(const std::array<Vec2, N>& points, uint32_t color) noexcept {
+    std::array<Vec2, N> p = points;
+    double area = 0;
+    for (size_t i = 0; i < N; ++i) {
+        area += cross(p[i], p[(i + 1) % N]);
+    }
+    if (area == 0) return;
+    if (area < 0) { std::reverse(p.begin(), p.end()); }
+
+    // edge functions e(x, y) = a*x + b*y + c, positive on the inside of every edge
+    std::array<double, N> a, b, c;
+    for (size_t i = 0; i < N; ++i) {
+        const Vec2& from = p[i];
+        const Vec2& to = p[(i + 1) % N];
+        a[i] = from.y - to.y;
+        b[i] = to.x - from.x;
+        c[i] = -(a[i] * from.x) - (b[i] * from.y);
+    }
+
+    double px_min = p[0].x, px_max = p[0].x, py_min = p[0].y, py_max = p[0].y;
+    for (const Vec2& v : p) {
+        px_min = std::min(px_min, v.x);
+        px_max = std::max(px_max, v.x);
+        py_min = std::min(py_min, v.y);
+        py_max = std::max(py_max, v.y);
+    }
+    int x_min = std::max(0, static_cast<int>(std::floor(px_min)));
+    int x_max = std::min(w - 1, static_cast<int>(std::floor(px_max)));
+    int y_min = std::max(0, static_cast<int>(std::floor(py_min)));
+    int y_max = std::min(h - 1, static_cast<int>(std::floor(py_max)));
+
+    // edge functions are linear, so over a pixel square their extremes sit on the corners and
+    // every sample is a fixed offset from the value at the pixel origin
+    const Vec2* offsets = samples == MSAA_8X ? SAMPLES_8X.data() : SAMPLES_4X.data();
+    std::array<double, N> lo, hi;
+    std::array<std::array<double, MSAA_8X>, N> sample_off;
+    for (size_t i = 0; i < N; ++i) {
+        lo[i] = std::min(a[i], 0.0) + std::min(b[i], 0.0);
+        hi[i] = std::max(a[i], 0.0) + std::max(b[i], 0.0);
+        for (int k = 0; k < samples; ++k) {
+            sample_off[i][k] = (a[i] * offsets[k].x) + (b[i] * offsets[k].y);
+        }
+    }
+
+    // first and last pixel of a row whose square reaches inside every edge, for the corner
+    // offsets hi, or lies fully inside every edge, for lo
+    auto clip_row = [&](int y, const std::array<double, N>& corner, int& x_start, int& x_end) {
+        double row_min = x_min;
+        double row_max = x_max;
+        for (size_t i = 0; i < N; ++i) {
+            double row_c = (b[i] * y) + c[i] + corner[i];
+            if (a[i] > 0) {
+                row_min = std::max(row_min, std::ceil(-row_c / a[i]));
+            } else if (a[i] < 0) {
+                row_max = std::min(row_max, std::floor(row_c / -a[i]));
+            } else if (row_c < 0) {
+                row_max = row_min - 1;
+            }
+        }
+        x_start = static_cast<int>(row_min);
+        x_end = static_cast<int>(row_max);
+    };
+
+    auto fill_partial = [&](int y, int x_start, int x_end) {
+        std::array<double, N> e;
+        for (size_t i = 0; i < N; ++i) {
+            e[i] = (a[i] * x_start) + (b[i] * y) + c[i];
+        }
+
+        for (int x = x_start; x <= x_end; ++x) {
+            uint32_t mask = 0;
+            for (int k = 0; k < samples; ++k) {
+                bool inside = true;
+                for (size_t i = 0; i < N; ++i) {
+                    inside = inside && e[i] + sample_off[i][k] >= 0;
+                }
+                mask |= inside ? 1u << k : 0;
+            }
+            write(x, y, mask, color);
+
+            for (size_t i = 0; i < N; ++i) {
+                e[i] += a[i];
+            }
+        }
+    };
+
+    // rows are clipped to the pixels the shape touches, so a thin shape costs its covered
+    // length rather than its bounding box, and only the ends of a span test samples
+    for (int y = y_min; y <= y_max; ++y) {
+        int x_start, x_end, inner_start, inner_end;
+        clip_row(y, hi, x_start, x_end);
+        if (x_start > x_end) continue;
+        clip_row(y, lo, inner_start, inner_end);
+        inner_start = std::max(inner_start, x_start);
+        inner_end = std::min(inner_end, x_end);
+        if (inner_start > inner_end) {
+            inner_start = x_end + 1;
+            inner_end = x_end;
+        }
+
+        fill_partial(y, x_start, inner_start - 1);
+        int row = w * y;
+        for (int x = inner_start; x <= inner_end; ++x) {
+            colors[row + x] = color;
+            slots[row + x] = -1;
+        }
+        fill_partial(y, inner_end + 1, x_end);
+    }
+}
\ No newline at end of file
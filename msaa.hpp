@@ -0,0 +1,45 @@
+#ifndef MSAA_H
+#define MSAA_H
+
+#include "vec.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+constexpr int MSAA_OFF = 0;
+constexpr int MSAA_4X = 4;
+constexpr int MSAA_8X = 8;
+
+// Coverage-mask sample buffer over a frame. Each pixel keeps its single color in the frame while
+// all of its samples agree; only pixels straddling an edge get a slot of `samples` colors in the
+// shared pool, and resolve only visits those.
+struct SampleBuffer {
+    public:
+        int w;
+        int h;
+        int samples;
+        uint32_t* colors;
+        std::vector<int32_t> slots;
+        std::vector<uint32_t> pool;
+        // pixels given a slot since the last resolve, may repeat
+        std::vector<int32_t> touched;
+
+        void resize(int width, int height, int sample_count);
+        // draws into frame until resolve, which averages the slotted pixels back into it
+        void begin(std::vector<uint32_t>& frame) noexcept;
+        void resolve() noexcept;
+
+        void write(int x, int y, uint32_t mask, uint32_t color) noexcept;
+        void fill_triangle(const std::array<Vec2, 3>& points, uint32_t color) noexcept;
+        void fill_line(Vec2 a, Vec2 b, uint32_t color) noexcept;
+
+        inline uint32_t full_mask() const noexcept { return (1u << samples) - 1u; }
+
+    private:
+        // points of a convex polygon in either winding
+        template <size_t N>
+        void fill_convex(const std::array<Vec2, N>& points, uint32_t color) noexcept;
+};
+
+#endif
\ No newline at end of file
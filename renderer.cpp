@@ -1,9 +1,18 @@
 #include "renderer.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstdint>
 
-void Renderer::initialize(std::string title, std::string mesh_path) {
+// returns the color of the current face and steps to the one for the next face, opaque alpha
+static uint32_t next_face_color(uint32_t& color) noexcept {
+    uint32_t face_color = color;
+    color = 0x000000ff | (color + 0x132480ff);
+    return face_color;
+}
+
+void Renderer::initialize(std::string title, std::string mesh_path, const RendererOptions& opts) {
     if (!SDL_Init(SDL_INIT_VIDEO)) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_init: %s", SDL_GetError());
         throw 1;
@@ -15,8 +24,8 @@ void Renderer::initialize(std::string title, std::string mesh_path) {
         throw 1;
     }
 
-    int window_width = 2160;
-    int window_height = 1440;
+    int window_width = WINDOW_WIDTH;
+    int window_height = WINDOW_HEIGHT;
 
     window = SDL_CreateWindow(title.c_str(), window_width, window_height, 0);
     if (window == NULL) {
@@ -41,18 +50,66 @@ void Renderer::initialize(std::string title, std::string mesh_path) {
         throw 1;
     }
 
-    w = window_width;
-    h = window_height;
-
-    c_buf = std::vector<uint32_t>(w*h, 0x00000000);
+    // the internal framebuffer may be smaller than the window, filter it back up on present
+    if (!SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_LINEAR)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Set texture scale mode: %s", SDL_GetError());
+        throw 1;
+    }
 
-    meshes.push_back(get_mesh_from_obj_file(mesh_path));
+    options = opts;
+    window_w = window_width;
+    window_h = window_height;
+    render_scale = options.dynamic_resolution ? options.max_scale : 1.0f;
+    frame_target_time_ns = static_cast<int64_t>((1.0f / options.target_fps) * 1.0e+9f);
+    raster_time_ns = 0;
+    geometry_time_ns = 0;
+
+    msaa_samples = MSAA_OFF;
+    resize_buffers(std::lround(window_w * render_scale), std::lround(window_h * render_scale));
+
+    loading = options.async_load;
+    if (loading) {
+        // rendered as it streams in, compact batches are quantized on the loader thread
+        if (options.compact_storage) {
+            compact_meshes.push_back(CompactMesh{});
+        } else {
+            meshes.push_back(Mesh{});
+        }
+        loader.start(mesh_path, options.compact_storage);
+    } else if (options.compact_storage) {
+        compact_meshes.push_back(compact_mesh(get_mesh_from_obj_file(mesh_path)));
+    } else {
+        meshes.push_back(get_mesh_from_obj_file(mesh_path));
+    }
     camera = Camera { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, 640.0 };
     triangles = {};
     prev_frame_time = SDL_GetTicksNS();
     flags = 0xff;
 }
 
+void Renderer::initialize_headless(float scale) {
+    window = NULL;
+    renderer = NULL;
+    texture = NULL;
+    display_mode = NULL;
+
+    window_w = WINDOW_WIDTH;
+    window_h = WINDOW_HEIGHT;
+    render_scale = scale;
+    frame_target_time_ns = static_cast<int64_t>(FRAME_TARGET_TIME_NS);
+    raster_time_ns = 0;
+    geometry_time_ns = 0;
+
+    msaa_samples = MSAA_OFF;
+    resize_buffers(std::lround(window_w * render_scale), std::lround(window_h * render_scale));
+
+    camera = Camera { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, 640.0 };
+    triangles = {};
+    prev_frame_time = 0;
+    flags = 0xff;
+    loading = false;
+}
+
 void Renderer::deinitialize() {
     SDL_DestroyWindow(window);
     SDL_DestroyRenderer(renderer);
@@ -106,6 +163,9 @@ bool Renderer::process_input() {
                         flags &= Vertices | Wireframe | PolygonFill;
                         flags |= ~BackfaceCulling;
                         break;
+                    case SDLK_M:
+                        set_msaa(msaa_samples == MSAA_OFF ? MSAA_4X : msaa_samples == MSAA_4X ? MSAA_8X : MSAA_OFF);
+                        break;
                     case SDLK_ESCAPE:
                         deinitialize();
                         return false;
@@ -122,63 +182,139 @@ bool Renderer::process_input() {
 }
 
 void Renderer::update() {
-    int window_width_offset = w/2;
-    int window_height_offset = h/2;
-    Triangle triangle;
-    Vec2 projected_point;
-
-    uint64_t time_to_wait = FRAME_TARGET_TIME_NS - (SDL_GetTicksNS() - prev_frame_time);
+    // signed, an overrun frame has nothing to wait for rather than wrapping to a huge delay
+    int64_t time_to_wait = frame_target_time_ns - static_cast<int64_t>(SDL_GetTicksNS() - prev_frame_time);
     if (time_to_wait > 0) {
         SDL_DelayNS(time_to_wait);
-        if (time_to_wait > FRAME_TARGET_TIME_NS) {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "wait time exceeded frame time: %llu, frame time: %f", time_to_wait, FRAME_TARGET_TIME_NS);
-        }
     }
     prev_frame_time = SDL_GetTicksNS();
 
-    for (Mesh& mesh : meshes) {
-        int i = 0;
-        // mesh.rot = global_rot;
-        uint32_t color = 0xccdd33ff;
-        for (const std::array<int, 3>& face : mesh.faces) {
-            std::array<Vec3, 3> face_vertices = {
-                mesh.vertices[face[0] - 1],
-                mesh.vertices[face[1] - 1],
-                mesh.vertices[face[2] - 1]
-            };
+    receive_mesh_batches();
+    for (const Mesh& mesh : meshes) {
+        transform_mesh(mesh);
+    }
+    for (const CompactMesh& mesh : compact_meshes) {
+        transform_mesh(mesh);
+    }
+    sort_triangles();
+    geometry_time_ns = SDL_GetTicksNS() - prev_frame_time;
+}
 
-            std::array<Vec3, 3> transformed_vertices;
-            for (int i = 0; i < 3; ++i) {
-                transformed_vertices[i] = rotate_axis_z(rotate_axis_y(rotate_axis_x(face_vertices[i], mesh.rot.x), mesh.rot.y), mesh.rot.z);
-                transformed_vertices[i] = rotate_axis_z(rotate_axis_y(rotate_axis_x(face_vertices[i], camera.rotation.x), camera.rotation.y), camera.rotation.z);
-                transformed_vertices[i].z += 5;
-            }
+void Renderer::receive_mesh_batches() {
+    if (!loading) return;
+
+    if (options.compact_storage) {
+        loader.poll(compact_meshes.back());
+    } else {
+        loader.poll(meshes.back());
+    }
+    if (!loader.done()) return;
+
+    loading = false;
+    if (!loader.error.empty()) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Load mesh: %s", loader.error.c_str());
+    }
+}
+
+void Renderer::transform_mesh(const Mesh& mesh) {
+    // mesh.rot = global_rot;
+    uint32_t color = 0xccdd33ff;
+    for (const std::array<int, 3>& face : mesh.faces) {
+        std::array<Vec3, 3> face_vertices = {
+            mesh.vertices[face[0] - 1],
+            mesh.vertices[face[1] - 1],
+            mesh.vertices[face[2] - 1]
+        };
+
+        std::array<Vec3, 3> transformed_vertices;
+        for (int i = 0; i < 3; ++i) {
+            transformed_vertices[i] = rotate_axis_z(rotate_axis_y(rotate_axis_x(face_vertices[i], mesh.rot.x), mesh.rot.y), mesh.rot.z);
+            transformed_vertices[i] = rotate_axis_z(rotate_axis_y(rotate_axis_x(face_vertices[i], camera.rotation.x), camera.rotation.y), camera.rotation.z);
+            transformed_vertices[i].z += 5;
+        }
+
+        uint32_t face_color = next_face_color(color);
+
+        if ((flags & BackfaceCulling) == BackfaceCulling) {
+            Vec3 normal = cross(transformed_vertices[1] - transformed_vertices[0], transformed_vertices[2] - transformed_vertices[0]);
+            Vec3 camera_ray = camera.position - transformed_vertices[0];
+            if (dot(normal, camera_ray) < 0) { continue; }
+        }
+
+        push_triangle(transformed_vertices, face_color);
+    }
+
+    // mesh.rot += 0.01;
+}
+
+void Renderer::transform_mesh(const CompactMesh& mesh) {
+    // columns of the camera rotation; each cluster folds its dequantization into them so that
+    // a vertex is a single multiply-add per axis: v = qx*mx + qy*my + qz*mz + offset
+    auto rotate = [this](const Vec3& v) {
+        return rotate_axis_z(rotate_axis_y(rotate_axis_x(v, camera.rotation.x), camera.rotation.y), camera.rotation.z);
+    };
+    Vec3 col_x = rotate(Vec3(1, 0, 0));
+    Vec3 col_y = rotate(Vec3(0, 1, 0));
+    Vec3 col_z = rotate(Vec3(0, 0, 1));
+
+    // shared vertices are transformed once rather than once per face corner
+    transformed.resize(mesh.positions.size());
+    for (const CompactCluster& cluster : mesh.clusters) {
+        Vec3 mx = col_x * cluster.bounds_step.x;
+        Vec3 my = col_y * cluster.bounds_step.y;
+        Vec3 mz = col_z * cluster.bounds_step.z;
+        Vec3 offset = rotate(cluster.bounds_min);
+        offset.z += 5;
+
+        for (size_t i = cluster.first_vertex; i < cluster.first_vertex + cluster.vertex_count; ++i) {
+            const std::array<uint16_t, 3>& q = mesh.positions[i];
+            transformed[i] = (mx * q[0]) + (my * q[1]) + (mz * q[2]) + offset;
+        }
+    }
+
+    uint32_t color = 0xccdd33ff;
+    for (const CompactCluster& cluster : mesh.clusters) {
+        for (size_t f = 0; f < cluster.face_count; ++f) {
+            std::array<Vec3, 3> transformed_vertices = {
+                transformed[mesh.index(cluster, 3*f)],
+                transformed[mesh.index(cluster, 3*f + 1)],
+                transformed[mesh.index(cluster, 3*f + 2)]
+            };
 
-            triangle.color = color;
-            color = 0x000000ff | color+0x132480ff;
+            uint32_t face_color = next_face_color(color);
 
             if ((flags & BackfaceCulling) == BackfaceCulling) {
-                Vec3 normal = cross(transformed_vertices[1] - transformed_vertices[0], transformed_vertices[2] - transformed_vertices[0]);
+                Vec3 n = decode_octahedral(mesh.normals[cluster.first_face + f]);
+                Vec3 normal = (col_x * n.x) + (col_y * n.y) + (col_z * n.z);
                 Vec3 camera_ray = camera.position - transformed_vertices[0];
                 if (dot(normal, camera_ray) < 0) { continue; }
             }
 
-            for (int i = 0; i < 3; ++i) {
-                projected_point = project_perspective(transformed_vertices[i]);
-                projected_point.x += window_width_offset;
-                projected_point.y += window_height_offset;
-
-                triangle.points[i] = projected_point;
-            }
-            triangle.avg_depth = (transformed_vertices[0].z + transformed_vertices[1].z + transformed_vertices[2].z) / 3;
-            triangles.push_back(triangle);
+            push_triangle(transformed_vertices, face_color);
         }
+    }
+}
 
-        // mesh.rot += 0.01;
+void Renderer::push_triangle(const std::array<Vec3, 3>& transformed_vertices, uint32_t color) {
+    int window_width_offset = w/2;
+    int window_height_offset = h/2;
+    Triangle triangle;
+    Vec2 projected_point;
+
+    triangle.color = color;
+    for (int i = 0; i < 3; ++i) {
+        projected_point = project_perspective(transformed_vertices[i]) * render_scale;
+        projected_point.x += window_width_offset;
+        projected_point.y += window_height_offset;
+
+        triangle.points[i] = projected_point;
     }
+    triangle.avg_depth = (transformed_vertices[0].z + transformed_vertices[1].z + transformed_vertices[2].z) / 3;
+    triangles.push_back(triangle);
+}
 
+void Renderer::sort_triangles() noexcept {
     // sort faces by depth (average z)
-    uint32_t color = 0xccdd33ff;
     for (Triangle& t1 : triangles) {
 
         for (Triangle& t2 : triangles) {
@@ -188,17 +324,82 @@ void Renderer::update() {
 }
 
 void Renderer::render() {
+    // only the rasterizer scales with resolution, geometry and sorting are timed in update
+    uint64_t raster_start_time = SDL_GetTicksNS();
+    rasterize();
+    raster_time_ns = SDL_GetTicksNS() - raster_start_time;
+
+    SDL_Rect src_rect = { 0, 0, w, h };
+    SDL_FRect src_frect = { 0.0f, 0.0f, static_cast<float>(w), static_cast<float>(h) };
+    if (w < window_w || h < window_h) {
+        // linear filtering at the edges of the rect would blend in texels past w and h, which
+        // still hold an earlier, larger frame, so sample from texel center to texel center
+        src_frect = { 0.5f, 0.5f, static_cast<float>(w - 1), static_cast<float>(h - 1) };
+    }
+    SDL_UpdateTexture(texture, &src_rect, c_buf.data(), sizeof(uint32_t) * w);
+    SDL_RenderTexture(renderer, texture, &src_frect, NULL);
+    SDL_RenderPresent(renderer);
+
+    update_render_scale();
+    clear_buffer();
+}
+
+void Renderer::rasterize() noexcept {
     draw_grid(0x333333ff);
+    if (msaa_samples != MSAA_OFF) { s_buf.begin(c_buf); }
 
     for (const Triangle& t : triangles) {
         draw_triangle(t, t.color, 0x00aabbff, 0xee4444ff);
     }
 
-    triangles = {};
-    SDL_UpdateTexture(texture, NULL, c_buf.data(), sizeof(uint32_t) * w);
-    SDL_RenderTexture(renderer, texture, NULL, NULL);
-    SDL_RenderPresent(renderer);
-    clear_buffer();
+    if (msaa_samples != MSAA_OFF) { s_buf.resolve(); }
+
+    // keeps its capacity for the next frame
+    triangles.clear();
+}
+
+bool Renderer::save_image(const std::string& path) {
+    SDL_Surface* surface = SDL_CreateSurfaceFrom(w, h, SDL_PIXELFORMAT_RGBA8888, c_buf.data(), sizeof(uint32_t) * w);
+    if (surface == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Create surface: %s", SDL_GetError());
+        return false;
+    }
+
+    bool saved = SDL_SaveBMP(surface, path.c_str());
+    if (!saved) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Save %s: %s", path.c_str(), SDL_GetError());
+    }
+    SDL_DestroySurface(surface);
+    return saved;
+}
+
+void Renderer::resize_buffers(int width, int height) {
+    w = width;
+    h = height;
+    c_buf.assign(w*h, 0x000000ff);
+    s_buf.resize(w, h, msaa_samples);
+}
+
+void Renderer::set_msaa(int samples) {
+    msaa_samples = samples;
+    s_buf.resize(w, h, msaa_samples);
+}
+
+void Renderer::update_render_scale() {
+    if (!options.dynamic_resolution || raster_time_ns == 0) return;
+
+    // the rasterizer gets what the geometry leaves of the budget, but never less than a floor,
+    // otherwise a mesh too heavy to transform in time would pin the scale at its minimum
+    double budget = std::max(frame_target_time_ns * RASTER_BUDGET_FRACTION - static_cast<double>(geometry_time_ns),
+                             frame_target_time_ns * MIN_RASTER_BUDGET_FRACTION);
+    // raster cost follows the pixel count, which grows with the square of the scale
+    float target = render_scale * std::sqrt(budget / raster_time_ns);
+    // grow slowly so a single cheap frame does not bounce the resolution back up
+    target = std::clamp(std::min(target, render_scale * 1.1f), options.min_scale, options.max_scale);
+    if (std::abs(target - render_scale) < render_scale * 0.05f) return;
+
+    render_scale = target;
+    resize_buffers(std::lround(window_w * render_scale), std::lround(window_h * render_scale));
 }
 
 Vec2 Renderer::project_orthographic(const Vec3& p) noexcept {
@@ -210,13 +411,14 @@ Vec2 Renderer::project_perspective(const Vec3& p) noexcept {
 }
 
 void Renderer::draw_grid(uint32_t color) noexcept {
-    for (int y = 0; y < h; y += 10) {
+    int spacing = std::max(1, static_cast<int>(10 * render_scale));
+    for (int y = 0; y < h; y += spacing) {
         for (int x = 0; x < w; x += 1) {
             c_buf[(w * y) + x] = color;
         }
     }
 
-    for (int x = 0; x < w; x += 10) {
+    for (int x = 0; x < w; x += spacing) {
         for (int y = 0; y < h; y += 1) {
             c_buf[(w * y) + x] = color;
         }
@@ -233,6 +435,10 @@ void Renderer::clear_buffer() noexcept {
 
 void Renderer::draw_pixel(int x, int y, uint32_t color) noexcept {
     if (x < 0 || x >= w || y < 0 || y >= h) return;
+    if (msaa_samples != MSAA_OFF) {
+        s_buf.write(x, y, s_buf.full_mask(), color);
+        return;
+    }
     c_buf[(w * y) + x] = color;
 }
 
@@ -256,6 +462,11 @@ void Renderer::draw_line_dda(int x1, int y1, int x2, int y2, uint32_t color) noe
 }
 
 void Renderer::draw_triangle(const Triangle& t, uint32_t fill_color, uint32_t wire_color, uint32_t vertex_color) noexcept {
+    if (msaa_samples != MSAA_OFF) {
+        draw_triangle_msaa(t, fill_color, wire_color, vertex_color);
+        return;
+    }
+
     std::array<Vec2, 3> points = { t.points[0], t.points[1], t.points[2] };
     if ((flags & PolygonFill) == PolygonFill) {
         if (points[0].y > points[1].y) { std::swap(points[0], points[1]); }
@@ -332,6 +543,22 @@ void Renderer::draw_triangle(const Triangle& t, uint32_t fill_color, uint32_t wi
     }
 }
 
+void Renderer::draw_triangle_msaa(const Triangle& t, uint32_t fill_color, uint32_t wire_color, uint32_t vertex_color) noexcept {
+    if ((flags & PolygonFill) == PolygonFill) {
+        s_buf.fill_triangle(t.points, fill_color);
+    }
+    if ((flags & Wireframe) == Wireframe) {
+        s_buf.fill_line(t.points[0], t.points[1], wire_color);
+        s_buf.fill_line(t.points[0], t.points[2], wire_color);
+        s_buf.fill_line(t.points[1], t.points[2], wire_color);
+    }
+    if ((flags & Vertices) == Vertices) {
+        draw_rectangle(t.points[0].x-1, t.points[0].y-1, 4, 4, vertex_color);
+        draw_rectangle(t.points[1].x-1, t.points[1].y-1, 4, 4, vertex_color);
+        draw_rectangle(t.points[2].x-1, t.points[2].y-1, 4, 4, vertex_color);
+    }
+}
+
 void Renderer::draw_rectangle(int x, int y, int width, int height, uint32_t color) noexcept {
     for (int j = 0; j < height; ++j) {
         for (int i = 0; i < width; ++i) {
@@ -2,7 +2,10 @@
 #define RENDERER_H
 
 #include "camera.hpp"
+#include "compact_mesh.hpp"
 #include "mesh.hpp"
+#include "mesh_loader.hpp"
+#include "msaa.hpp"
 #include "string_utils.hpp"
 #include "triangle.hpp"
 
@@ -11,9 +14,15 @@
 #include <chrono>
 #include <iostream>
 
+constexpr int WINDOW_WIDTH = 2160;
+constexpr int WINDOW_HEIGHT = 1440;
+
 constexpr float FPS_30 = 30.0f;
 constexpr float FPS_60 = 60.0f;
 constexpr float FRAME_TARGET_TIME_NS = (1.0f / FPS_60) * 1.0e+9f;
+// share of the frame budget the rasterizer may use before the internal resolution drops
+constexpr double RASTER_BUDGET_FRACTION = 0.8;
+constexpr double MIN_RASTER_BUDGET_FRACTION = 0.25;
 
 enum DisplayFlags {
     Vertices        = 0x01,
@@ -22,6 +31,16 @@ enum DisplayFlags {
     BackfaceCulling = 0x08,
 };
 
+struct RendererOptions {
+    public:
+        float target_fps = FPS_60;
+        bool dynamic_resolution = false;
+        float min_scale = 0.5f;
+        float max_scale = 1.0f;
+        bool compact_storage = false;
+        bool async_load = true;
+};
+
 class Renderer {
     using enum DisplayFlags;
     public:
@@ -29,20 +48,35 @@ class Renderer {
         SDL_Renderer* renderer;
         SDL_Texture* texture;
         const SDL_DisplayMode* display_mode;
+        RendererOptions options;
+        int window_w;
+        int window_h;
         int w;
         int h;
+        float render_scale;
         std::vector<uint32_t> c_buf;
+        SampleBuffer s_buf;
+        int msaa_samples;
         std::vector<Mesh> meshes;
+        std::vector<CompactMesh> compact_meshes;
+        MeshLoader loader;
+        bool loading;
         Camera camera;
         SDL_Event event;
         std::vector<Triangle> triangles;
+        std::vector<Vec3> transformed;
         uint64_t prev_frame_time;
+        int64_t frame_target_time_ns;
+        uint64_t geometry_time_ns;
+        uint64_t raster_time_ns;
         // Vec3 global_rot;
         uint8_t flags;
 
         Renderer() = default;
 
-        void initialize(std::string title, std::string mesh_path);
+        void initialize(std::string title, std::string mesh_path, const RendererOptions& opts = {});
+        // framebuffer only, no window or SDL state; sized like the window times scale
+        void initialize_headless(float scale = 1.0f);
         bool process_input();
         void deinitialize();
 
@@ -53,12 +87,27 @@ class Renderer {
         void update();
         void render();
 
+        void receive_mesh_batches();
+
+        void transform_mesh(const Mesh& mesh);
+        void transform_mesh(const CompactMesh& mesh);
+        void push_triangle(const std::array<Vec3, 3>& transformed_vertices, uint32_t color);
+        void sort_triangles() noexcept;
+        void rasterize() noexcept;
+        bool save_image(const std::string& path);
+
+        void resize_buffers(int width, int height);
+        // one of MSAA_OFF, MSAA_4X or MSAA_8X, takes effect from the next rasterize
+        void set_msaa(int samples);
+        void update_render_scale();
+
         void draw_grid(uint32_t color) noexcept;
 
         void clear_buffer() noexcept;
         void draw_pixel(int x, int y, uint32_t color) noexcept;
         void draw_line_dda(int x1, int y1, int x2, int y2, uint32_t color) noexcept;
         void draw_triangle(const Triangle& t, uint32_t fill_color, uint32_t wire_color, uint32_t vertex_color) noexcept;
+        void draw_triangle_msaa(const Triangle& t, uint32_t fill_color, uint32_t wire_color, uint32_t vertex_color) noexcept;
         void draw_rectangle(int x, int y, int width, int height, uint32_t color) noexcept;
 };
 
@@ -0,0 +1,128 @@
+#include "renderer.hpp"
+#include "synthetic_mesh.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+// keeps results of pure functions alive so the optimizer cannot drop the work
+volatile size_t sink;
+
+// setup runs before every call of f, outside the timed region
+template <typename F, typename S>
+void bench(const char* name, int iterations, F&& f, S&& setup) {
+    setup();
+    f();
+
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; ++i) {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        f();
+        samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::sort(samples.begin(), samples.end());
+    SDL_Log("%-28s median %12.2f us   min %12.2f us", name, samples[samples.size() / 2], samples[0]);
+}
+
+template <typename F>
+void bench(const char* name, int iterations, F&& f) {
+    bench(name, iterations, f, []() {});
+}
+
+int main(int argc, const char* argv[]) {
+    int face_count = 20000;
+    int iterations = 20;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg { argv[i] };
+        if (arg == "--faces") {
+            face_count = std::stoi(argv[i + 1]);
+        } else if (arg == "--iterations") {
+            iterations = std::stoi(argv[i + 1]);
+        } else {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "usage: ./renderer_bench [--faces <n>] [--iterations <n>]");
+            return 1;
+        }
+    }
+
+    Mesh mesh = make_sphere_mesh(face_count);
+    SDL_Log("synthetic sphere: %zu vertices, %zu faces, %d iterations", mesh.vertices.size(), mesh.faces.size(), iterations);
+
+    bench("split (vertex line)", iterations, []() {
+        for (int i = 0; i < 1000; ++i) {
+            sink = split("v 0.125000 -1.500000 0.750000", " ").size();
+        }
+    });
+    bench("split (face line)", iterations, []() {
+        for (int i = 0; i < 1000; ++i) {
+            sink = split("1/1/1 2/2/2 3/3/3", { " ", "/" }).size();
+        }
+    });
+
+    std::string obj_path = (std::filesystem::temp_directory_path() / "renderer_bench.obj").string();
+    write_obj_file(mesh, obj_path);
+    bench("get_mesh_from_obj_file", iterations, [&]() {
+        sink = get_mesh_from_obj_file(obj_path).faces.size();
+    });
+    std::filesystem::remove(obj_path);
+
+    Renderer rs;
+    rs.initialize_headless();
+
+    bench("clear_buffer", iterations, [&]() { rs.clear_buffer(); });
+
+    bench("draw_line_dda x1000", iterations, [&]() {
+        uint32_t seed = 1;
+        auto next = [&seed](int range) { seed = (seed * 1664525u) + 1013904223u; return static_cast<int>((seed >> 8) % range); };
+        for (int i = 0; i < 1000; ++i) {
+            rs.draw_line_dda(next(rs.w), next(rs.h), next(rs.w), next(rs.h), 0x00aabbff);
+        }
+    });
+
+    bench("transform_mesh", iterations, [&]() {
+        rs.triangles.clear();
+        rs.transform_mesh(mesh);
+    });
+
+    CompactMesh compact = compact_mesh(mesh);
+    size_t full_bytes = (mesh.vertices.size() * sizeof(Vec3)) + (mesh.faces.size() * (2 * sizeof(std::array<int, 3>) + sizeof(Vec3)));
+    size_t compact_bytes = (compact.positions.size() * sizeof(compact.positions[0])) + (compact.indices16.size() * sizeof(uint16_t))
+        + (compact.indices32.size() * sizeof(uint32_t)) + (compact.normals.size() * sizeof(compact.normals[0]));
+    SDL_Log("mesh storage: %zu bytes, compact: %zu bytes", full_bytes, compact_bytes);
+    bench("transform_mesh (compact)", iterations, [&]() {
+        rs.triangles.clear();
+        rs.transform_mesh(compact);
+    });
+
+    // the sort runs in place, so every iteration sorts a fresh copy of the same input
+    std::vector<Triangle> unsorted = rs.triangles;
+    bench("sort_triangles", iterations, [&]() {
+        rs.triangles = unsorted;
+        rs.sort_triangles();
+    });
+    std::vector<Triangle> sorted = rs.triangles;
+
+    for (int samples : { MSAA_OFF, MSAA_4X, MSAA_8X }) {
+        rs.set_msaa(samples);
+        // the resolve only visits the edge pixels the draw produced, so it is timed with it
+        auto draw = [&]() {
+            for (const Triangle& t : sorted) {
+                rs.draw_triangle(t, t.color, 0x00aabbff, 0xee4444ff);
+            }
+            if (samples != MSAA_OFF) { rs.s_buf.resolve(); }
+        };
+        auto begin = [&]() { if (samples != MSAA_OFF) { rs.s_buf.begin(rs.c_buf); } };
+
+        rs.flags = PolygonFill;
+        std::string name = std::format("draw_triangle fill msaa {}", samples);
+        bench(name.c_str(), iterations, draw, begin);
+
+        rs.flags = Wireframe;
+        name = std::format("draw_triangle wire msaa {}", samples);
+        bench(name.c_str(), iterations, draw, begin);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "renderer.hpp"
+#include "synthetic_mesh.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+
+// channel difference allowed before a pixel counts as changed, and the share of changed pixels
+// tolerated, so rounding differences between compilers do not fail the comparison
+constexpr int CHANNEL_TOLERANCE = 8;
+constexpr double PIXEL_TOLERANCE = 0.001;
+
+struct Scene {
+    public:
+        std::string name;
+        std::string reference;
+        Mesh mesh;
+        Vec3 rotation;
+        uint8_t flags;
+        int msaa_samples;
+        bool compact;
+};
+
+std::vector<uint32_t> render_scene(const Scene& scene, int& w, int& h) {
+    Renderer rs;
+    rs.initialize_headless(0.125f);
+    rs.flags = scene.flags;
+    rs.set_msaa(scene.msaa_samples);
+    rs.camera.rotation = scene.rotation;
+
+    if (scene.compact) {
+        rs.transform_mesh(compact_mesh(scene.mesh));
+    } else {
+        rs.transform_mesh(scene.mesh);
+    }
+    rs.sort_triangles();
+    rs.rasterize();
+
+    w = rs.w;
+    h = rs.h;
+    return rs.c_buf;
+}
+
+bool save_bmp(const std::string& path, std::vector<uint32_t>& pixels, int w, int h) {
+    SDL_Surface* surface = SDL_CreateSurfaceFrom(w, h, SDL_PIXELFORMAT_RGBA8888, pixels.data(), sizeof(uint32_t) * w);
+    if (surface == NULL) return false;
+    bool saved = SDL_SaveBMP(surface, path.c_str());
+    SDL_DestroySurface(surface);
+    return saved;
+}
+
+bool load_bmp(const std::string& path, std::vector<uint32_t>& pixels, int& w, int& h) {
+    SDL_Surface* loaded = SDL_LoadBMP(path.c_str());
+    if (loaded == NULL) return false;
+    SDL_Surface* surface = SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA8888);
+    SDL_DestroySurface(loaded);
+    if (surface == NULL) return false;
+
+    w = surface->w;
+    h = surface->h;
+    pixels.resize(w * h);
+    for (int y = 0; y < h; ++y) {
+        const uint32_t* row = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(surface->pixels) + (y * surface->pitch));
+        std::copy(row, row + w, pixels.begin() + (y * w));
+    }
+    SDL_DestroySurface(surface);
+    return true;
+}
+
+int main(int argc, const char* argv[]) {
+    if (argc < 2) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "usage: ./renderer_golden_test <reference_dir> [--update]");
+        return 1;
+    }
+    std::filesystem::path reference_dir { argv[1] };
+    bool update = argc > 2 && std::string(argv[2]) == "--update";
+
+    // compact scenes share the reference of their full precision twin
+    std::vector<Scene> scenes = {
+        { "cube_all", "cube_all", make_cube_mesh(), Vec3(0.5, 0.6, 0.0), Vertices | Wireframe | PolygonFill | BackfaceCulling, MSAA_OFF, false },
+        { "sphere_fill", "sphere_fill", make_sphere_mesh(800), Vec3(0.3, 0.0, 0.2), PolygonFill | BackfaceCulling, MSAA_OFF, false },
+        { "sphere_wire_msaa4", "sphere_wire_msaa4", make_sphere_mesh(200), Vec3(0.0, 0.4, 0.0), Wireframe | BackfaceCulling, MSAA_4X, false },
+        { "cube_fill_msaa8", "cube_fill_msaa8", make_cube_mesh(), Vec3(0.7, 0.3, 0.1), PolygonFill | Wireframe | BackfaceCulling, MSAA_8X, false },
+        { "cube_all_compact", "cube_all", make_cube_mesh(), Vec3(0.5, 0.6, 0.0), Vertices | Wireframe | PolygonFill | BackfaceCulling, MSAA_OFF, true },
+        { "sphere_fill_compact", "sphere_fill", make_sphere_mesh(800), Vec3(0.3, 0.0, 0.2), PolygonFill | BackfaceCulling, MSAA_OFF, true },
+    };
+
+    int failures = 0;
+    for (const Scene& scene : scenes) {
+        int w, h;
+        std::vector<uint32_t> actual = render_scene(scene, w, h);
+        std::string reference_path = (reference_dir / (scene.reference + ".bmp")).string();
+
+        if (update) {
+            if (scene.compact) continue;
+            if (!save_bmp(reference_path, actual, w, h)) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: failed to write %s", scene.name.c_str(), reference_path.c_str());
+                ++failures;
+            }
+            continue;
+        }
+
+        int ref_w, ref_h;
+        std::vector<uint32_t> expected;
+        if (!load_bmp(reference_path, expected, ref_w, ref_h)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: missing reference %s, rerun with --update", scene.name.c_str(), reference_path.c_str());
+            ++failures;
+            continue;
+        }
+        if (ref_w != w || ref_h != h) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: size %dx%d, reference is %dx%d", scene.name.c_str(), w, h, ref_w, ref_h);
+            ++failures;
+            continue;
+        }
+
+        int changed = 0;
+        for (int i = 0; i < w*h; ++i) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                int a = (actual[i] >> shift) & 0xff;
+                int b = (expected[i] >> shift) & 0xff;
+                if (std::abs(a - b) > CHANNEL_TOLERANCE) {
+                    ++changed;
+                    break;
+                }
+            }
+        }
+
+        if (changed > PIXEL_TOLERANCE * w * h) {
+            std::string actual_path = scene.name + ".actual.bmp";
+            save_bmp(actual_path, actual, w, h);
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: %d of %d pixels differ, wrote %s", scene.name.c_str(), changed, w*h, actual_path.c_str());
+            ++failures;
+        } else {
+            SDL_Log("%s: ok (%d pixels differ)", scene.name.c_str(), changed);
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
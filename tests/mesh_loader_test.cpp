@@ -0,0 +1,112 @@
+#include "mesh_loader.hpp"
+#include "synthetic_mesh.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <cmath>
+#include <filesystem>
+#include <numbers>
+
+// angle a streamed face normal may be off from the one compact_mesh computes, 0.3 degrees
+const double MIN_NORMAL_COS = std::cos(0.3 * std::numbers::pi / 180.0);
+
+// streams an obj bigger than one batch through MeshLoader; every prefix may only reference
+// vertices that already arrived and the result must match the synchronous loader
+int main() {
+    std::string obj_path = (std::filesystem::temp_directory_path() / "renderer_loader_test.obj").string();
+    Mesh source = make_sphere_mesh(40000);
+    write_obj_file(source, obj_path);
+    Mesh expected = get_mesh_from_obj_file(obj_path);
+    CompactMesh expected_compact = compact_mesh(expected);
+
+    int failures = 0;
+    auto check = [&failures](bool ok, const char* what) {
+        if (!ok) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "mesh_loader: %s", what);
+            ++failures;
+        }
+    };
+    check(source.vertices.size() + source.faces.size() > 2 * MESH_BATCH_ELEMENTS, "test mesh fits in two batches");
+
+    Mesh mesh;
+    int batches = 0;
+    bool prefix_ok = true;
+    {
+        MeshLoader loader;
+        loader.start(obj_path);
+        while (!loader.done()) {
+            if (!loader.poll(mesh)) continue;
+            ++batches;
+            for (const std::array<int, 3>& face : mesh.faces) {
+                for (int i : face) {
+                    prefix_ok = prefix_ok && i >= 1 && static_cast<size_t>(i) <= mesh.vertices.size();
+                }
+            }
+        }
+        loader.poll(mesh);
+        check(loader.error.empty(), "loader reported an error");
+    }
+    check(prefix_ok, "a face referenced a vertex that had not arrived");
+    check(mesh.vertices == expected.vertices, "vertices differ from get_mesh_from_obj_file");
+    check(mesh.faces == expected.faces && mesh.textures == expected.textures && mesh.normals == expected.normals,
+          "faces differ from get_mesh_from_obj_file");
+
+    CompactMesh compact;
+    prefix_ok = true;
+    {
+        MeshLoader loader;
+        loader.start(obj_path, true);
+        while (!loader.done()) {
+            if (!loader.poll(compact)) continue;
+            for (const CompactCluster& cluster : compact.clusters) {
+                for (size_t i = 0; i < cluster.face_count * 3; ++i) {
+                    prefix_ok = prefix_ok && compact.index(cluster, i) < compact.positions.size();
+                }
+            }
+        }
+        loader.poll(compact);
+    }
+    check(prefix_ok, "a compact face referenced a vertex that had not arrived");
+
+    // batches are quantized within their own bounds, so positions only round trip to half a step
+    bool positions_ok = compact.positions.size() == expected.vertices.size();
+    for (const CompactCluster& cluster : compact.clusters) {
+        for (size_t i = cluster.first_vertex; positions_ok && i < cluster.first_vertex + cluster.vertex_count; ++i) {
+            Vec3 error = compact.dequantize(i) - expected.vertices[i];
+            positions_ok = std::abs(error.x) <= cluster.bounds_step.x * 0.501
+                && std::abs(error.y) <= cluster.bounds_step.y * 0.501
+                && std::abs(error.z) <= cluster.bounds_step.z * 0.501;
+        }
+    }
+    check(positions_ok, "compact positions differ from get_mesh_from_obj_file by more than half a step");
+
+    bool indices_ok = compact.face_count() == expected.faces.size();
+    for (const CompactCluster& cluster : compact.clusters) {
+        for (size_t f = 0; indices_ok && f < cluster.face_count; ++f) {
+            const std::array<int, 3>& face = expected.faces[cluster.first_face + f];
+            for (int k = 0; k < 3; ++k) {
+                indices_ok = indices_ok && compact.index(cluster, (3 * f) + k) == static_cast<uint32_t>(face[k] - 1);
+            }
+        }
+    }
+    check(indices_ok, "compact indices differ from get_mesh_from_obj_file");
+
+    // streamed normals come from the quantized positions, compact_mesh uses the exact ones
+    bool normals_ok = compact.face_count() == expected_compact.face_count();
+    for (size_t f = 0; normals_ok && f < compact.face_count(); ++f) {
+        normals_ok = dot(decode_octahedral(compact.normals[f]), decode_octahedral(expected_compact.normals[f])) >= MIN_NORMAL_COS;
+    }
+    check(normals_ok, "compact normals differ from compact_mesh by more than 0.3 degrees");
+
+    // destroyed mid-load, the destructor has to stop and join the loader thread
+    for (bool compact_mode : { false, true }) {
+        MeshLoader loader;
+        loader.start(obj_path, compact_mode);
+    }
+
+    std::filesystem::remove(obj_path);
+    if (failures == 0) {
+        SDL_Log("mesh_loader: ok (%d polls received data)", batches);
+    }
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef SYNTHETIC_MESH_H
+#define SYNTHETIC_MESH_H
+
+#include "mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numbers>
+#include <string>
+
+inline void add_face(Mesh& mesh, int a, int b, int c) {
+    mesh.faces.push_back({ a, b, c });
+    mesh.textures.push_back({ 1, 1, 1 });
+    mesh.normals.push_back(Vec3(1, 1, 1));
+}
+
+// UV sphere with roughly `face_count` outward wound faces, 1-based like get_mesh_from_obj_file.
+inline Mesh make_sphere_mesh(int face_count, double radius = 1.5) {
+    int segments = std::max(3, static_cast<int>(std::sqrt(face_count / 2.0)));
+    int rings = std::max(2, segments);
+    Mesh mesh;
+
+    mesh.vertices.push_back(Vec3(0, radius, 0));
+    for (int r = 1; r < rings; ++r) {
+        double phi = (std::numbers::pi * r) / rings;
+        for (int s = 0; s < segments; ++s) {
+            double theta = (2.0 * std::numbers::pi * s) / segments;
+            mesh.vertices.push_back(Vec3(radius * std::sin(phi) * std::cos(theta), radius * std::cos(phi), radius * std::sin(phi) * std::sin(theta)));
+        }
+    }
+    mesh.vertices.push_back(Vec3(0, -radius, 0));
+
+    auto ring_vertex = [segments](int r, int s) { return 2 + ((r - 1) * segments) + (s % segments); };
+    int bottom = static_cast<int>(mesh.vertices.size());
+    for (int s = 0; s < segments; ++s) {
+        add_face(mesh, 1, ring_vertex(1, s + 1), ring_vertex(1, s));
+        for (int r = 1; r < rings - 1; ++r) {
+            add_face(mesh, ring_vertex(r, s), ring_vertex(r, s + 1), ring_vertex(r + 1, s + 1));
+            add_face(mesh, ring_vertex(r, s), ring_vertex(r + 1, s + 1), ring_vertex(r + 1, s));
+        }
+        add_face(mesh, bottom, ring_vertex(rings - 1, s), ring_vertex(rings - 1, s + 1));
+    }
+
+    return mesh;
+}
+
+inline Mesh make_cube_mesh() {
+    Mesh mesh;
+    for (double x : { -1.0, 1.0 }) {
+        for (double y : { -1.0, 1.0 }) {
+            for (double z : { -1.0, 1.0 }) {
+                mesh.vertices.push_back(Vec3(x, y, z));
+            }
+        }
+    }
+
+    add_face(mesh, 1, 3, 7); add_face(mesh, 1, 7, 5);
+    add_face(mesh, 2, 6, 8); add_face(mesh, 2, 8, 4);
+    add_face(mesh, 1, 5, 6); add_face(mesh, 1, 6, 2);
+    add_face(mesh, 3, 4, 8); add_face(mesh, 3, 8, 7);
+    add_face(mesh, 1, 2, 4); add_face(mesh, 1, 4, 3);
+    add_face(mesh, 5, 7, 8); add_face(mesh, 5, 8, 6);
+    return mesh;
+}
+
+inline void write_obj_file(const Mesh& mesh, const std::string& file_path) {
+    std::ofstream ofile(file_path);
+    for (const Vec3& v : mesh.vertices) {
+        ofile << "v " << v.x << " " << v.y << " " << v.z << "\n";
+    }
+    for (const std::array<int, 3>& f : mesh.faces) {
+        ofile << "f " << f[0] << "/1/1 " << f[1] << "/1/1 " << f[2] << "/1/1\n";
+    }
+}
+
+#endif
\ No newline at end of file